@@ -33,18 +33,51 @@
     }                                           \
   } while (0)
 
-#define CHECK_TRACE(trace_call)                               \
-  do {                                                        \
-    if ((trace_call) != 0) {                                  \
-      ERL_RAISE("tried to get trace but it was nulled out");  \
-    }                                                         \
+// Bails out if `lock_trace()` failed, in which case the trace is not locked.
+// Reaped traces belong to requests that are still running, so using them must
+// not break the request: we just return `error`.
+#define CHECK_TRACE(trace_call)                                 \
+  do {                                                          \
+    switch (trace_call) {                                       \
+    case 0:                                                     \
+      break;                                                    \
+    case TRACE_REAPED:                                          \
+      return atom_error;                                        \
+    default:                                                    \
+      ERL_RAISE("tried to get trace but it was nulled out");    \
+    }                                                           \
   } while (0)
 
+// Return codes for `lock_trace()`.
+#define TRACE_NULLED -1
+#define TRACE_REAPED -2
+
+// What a `TRACE_RES_TYPE` resource points to.
+//
+// Besides the `sky_trace_t` itself, each trace resource is a node in the trace
+// index (see `trace_index_head` below): `prev` and `next` are the links in the
+// index, and `indexed` tells whether the node is currently in it. `lock`
+// protects `trace` and `reaped`, since the reaper can free a trace while the
+// process that owns it is running.
+typedef struct trace_res {
+  sky_trace_t *trace;
+  uint64_t started_at;
+  int reaped;
+  int indexed;
+  ErlNifMutex *lock;
+  struct trace_res *prev;
+  struct trace_res *next;
+} trace_res_t;
+
 // Helper function headers.
 sky_buf_t bin2buf(ErlNifBinary bin);
-ErlNifBinary buf2bin(sky_buf_t buf);
+ERL_NIF_TERM buf2term(ErlNifEnv *, sky_buf_t);
 void get_instrumenter(ErlNifEnv *, ERL_NIF_TERM, sky_instrumenter_t **);
-int get_trace(ErlNifEnv *, ERL_NIF_TERM, sky_trace_t **);
+int lock_trace(ErlNifEnv *, ERL_NIF_TERM, trace_res_t **);
+void unlock_trace(trace_res_t *);
+void trace_index_insert(trace_res_t *);
+void trace_index_remove(trace_res_t *);
+void trace_index_unlink(trace_res_t *);
 
 
 // Global atoms to be used throughout the functions.
@@ -62,6 +95,18 @@ ErlNifResourceType *INSTRUMENTER_RES_TYPE;
 // Resource type for Skylight traces. Initialized in the `load` function.
 ErlNifResourceType *TRACE_RES_TYPE;
 
+// Index of all the live traces, as a doubly linked list of trace resources
+// sorted by start time (oldest first). Traces are added when they're created
+// and removed when they're submitted, reaped or garbage-collected. This lets
+// `trace_reap()` find traces that have been running for too long without
+// walking anything but the expired traces.
+//
+// The index is protected by `TRACE_INDEX_LOCK`. The index lock can be held
+// while locking a trace (with a trylock only), but never the other way around.
+ErlNifMutex *TRACE_INDEX_LOCK;
+trace_res_t *trace_index_head = NULL;
+trace_res_t *trace_index_tail = NULL;
+
 // Destructor for `INSTRUMENTER_RES_TYPE` resources.
 void instrumenter_res_destructor(ErlNifEnv *env, void *obj) {
   sky_instrumenter_t **inst_res = obj;
@@ -81,11 +126,19 @@ void trace_res_destructor(ErlNifEnv *env, void *obj) {
   // resources around, which are pointers to traces and instrumenters: this way,
   // the resource pointer always stays valid but at some point it will point to
   // NULL.
-  sky_trace_t **trace_res = obj;
+  //
+  // Since nobody else references this resource anymore, the only one that can
+  // still reach it is the reaper through the trace index, so we take it out of
+  // the index first.
+  trace_res_t *trace_res = obj;
+
+  trace_index_remove(trace_res);
 
-  if (*trace_res != NULL) {
-    sky_trace_free(*trace_res);
+  if (trace_res->trace != NULL) {
+    sky_trace_free(trace_res->trace);
   }
+
+  enif_mutex_destroy(trace_res->lock);
 }
 
 // Load hook. Called by Erlang when this NIF library is loaded and there is no
@@ -111,6 +164,11 @@ int load(ErlNifEnv *env, void **priv_data, ERL_NIF_TERM load_info) {
   TRACE_RES_TYPE =
     enif_open_resource_type(env, NULL, "trace", trace_res_destructor, res_flags, NULL);
 
+  TRACE_INDEX_LOCK = enif_mutex_create((char *) "skylight_trace_index");
+  if (TRACE_INDEX_LOCK == NULL) {
+    return -1;
+  }
+
   return 0;
 }
 
@@ -253,15 +311,25 @@ static ERL_NIF_TERM sky_instrumenter_submit_trace_nif(ErlNifEnv *env, int argc,
   sky_instrumenter_t *instrumenter;
   get_instrumenter(env, argv[0], &instrumenter);
 
-  sky_trace_t **trace_res;
-  enif_get_resource(env, argv[1], TRACE_RES_TYPE, (void **) &trace_res);
+  // A trace that was already submitted or reaped can't be submitted.
+  trace_res_t *trace_res;
+  if (lock_trace(env, argv[1], &trace_res) != 0) {
+    return atom_error;
+  }
 
-  int res = sky_instrumenter_submit_trace((const sky_instrumenter_t *) instrumenter, *trace_res);
+  int res = sky_instrumenter_submit_trace((const sky_instrumenter_t *) instrumenter, trace_res->trace);
 
   // sky_instrumenter_submit_trace() frees the trace, but to be sure let's NULL
   // it out manually.
   if (res == 0) {
-    *trace_res = NULL;
+    trace_res->trace = NULL;
+  }
+
+  unlock_trace(trace_res);
+
+  // The trace is gone, so the reaper doesn't need to know about it anymore.
+  if (res == 0) {
+    trace_index_remove(trace_res);
   }
 
   return FFI_RESULT(res);
@@ -313,9 +381,23 @@ static ERL_NIF_TERM sky_trace_new_nif(ErlNifEnv *env, int argc, const ERL_NIF_TE
   enif_inspect_binary(env, argv[1], &uuid_bin);
   enif_inspect_binary(env, argv[2], &endpoint_bin);
 
-  // We allocate the space for a trace resource, which is just a pointer to a
-  // `sky_trace_t`.
-  sky_trace_t **trace_res = enif_alloc_resource(TRACE_RES_TYPE, sizeof(sky_trace_t *));
+  ErlNifMutex *lock = enif_mutex_create((char *) "skylight_trace");
+  if (lock == NULL) {
+    ERL_RAISE("couldn't create the trace lock");
+  }
+
+  // We allocate the space for a trace resource, which is a `trace_res_t`
+  // wrapping a pointer to a `sky_trace_t`.
+  trace_res_t *trace_res = enif_alloc_resource(TRACE_RES_TYPE, sizeof(trace_res_t));
+  *trace_res = (trace_res_t) {
+    .trace = NULL,
+    .started_at = (uint64_t) start,
+    .reaped = 0,
+    .indexed = 0,
+    .lock = lock,
+    .prev = NULL,
+    .next = NULL,
+  };
   // We then immediately create the Erlang resource...
   ERL_NIF_TERM term = enif_make_resource(env, trace_res);
   // ...and immediately release the resource, transferring its ownership to
@@ -326,7 +408,9 @@ static ERL_NIF_TERM sky_trace_new_nif(ErlNifEnv *env, int argc, const ERL_NIF_TE
   MAYBE_RAISE_FFI(sky_trace_new((uint64_t) start,
                                 bin2buf(uuid_bin),
                                 bin2buf(endpoint_bin),
-                                trace_res));
+                                &trace_res->trace));
+
+  trace_index_insert(trace_res);
 
   return term;
 }
@@ -338,11 +422,14 @@ static ERL_NIF_TERM sky_trace_new_nif(ErlNifEnv *env, int argc, const ERL_NIF_TE
 static ERL_NIF_TERM sky_trace_start_nif(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[]) {
   RAISE_IF_LIBSKYLIGHT_NOT_LOADED();
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
 
   uint64_t out;
-  MAYBE_RAISE_FFI(sky_trace_start(trace, &out));
+  int res = sky_trace_start(trace_res->trace, &out);
+  unlock_trace(trace_res);
+
+  MAYBE_RAISE_FFI(res);
 
   return enif_make_uint64(env, (ErlNifUInt64) out);
 }
@@ -354,15 +441,19 @@ static ERL_NIF_TERM sky_trace_start_nif(ErlNifEnv *env, int argc, const ERL_NIF_
 static ERL_NIF_TERM sky_trace_endpoint_nif(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[]) {
   RAISE_IF_LIBSKYLIGHT_NOT_LOADED();
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
 
+  // The returned buffer points inside the trace, so we copy it while we still
+  // hold the lock (the reaper could free the trace right after).
   sky_buf_t endpoint_buf;
-  MAYBE_RAISE_FFI(sky_trace_endpoint(trace, &endpoint_buf));
+  int res = sky_trace_endpoint(trace_res->trace, &endpoint_buf);
+  ERL_NIF_TERM endpoint = (res == 0) ? buf2term(env, endpoint_buf) : atom_error;
+  unlock_trace(trace_res);
 
-  ErlNifBinary endpoint_bin = buf2bin(endpoint_buf);
+  MAYBE_RAISE_FFI(res);
 
-  return enif_make_binary(env, &endpoint_bin);
+  return endpoint;
 }
 
 // Wraps:
@@ -374,15 +465,17 @@ static ERL_NIF_TERM sky_trace_set_endpoint_nif(ErlNifEnv *env, int argc, const E
 
   CHECK_TYPE(argv[1], binary);
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
-
   ErlNifBinary endpoint_bin;
   enif_inspect_binary(env, argv[1], &endpoint_bin);
 
   sky_buf_t endpoint_buf = bin2buf(endpoint_bin);
 
-  int res = sky_trace_set_endpoint(trace, endpoint_buf);
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
+
+  int res = sky_trace_set_endpoint(trace_res->trace, endpoint_buf);
+  unlock_trace(trace_res);
+
   return FFI_RESULT(res);
 }
 
@@ -393,15 +486,18 @@ static ERL_NIF_TERM sky_trace_set_endpoint_nif(ErlNifEnv *env, int argc, const E
 static ERL_NIF_TERM sky_trace_uuid_nif(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[]) {
   RAISE_IF_LIBSKYLIGHT_NOT_LOADED();
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
 
+  // Same as in trace_endpoint/1: copy the UUID before releasing the lock.
   sky_buf_t uuid_buf;
-  MAYBE_RAISE_FFI(sky_trace_uuid(trace, &uuid_buf));
+  int res = sky_trace_uuid(trace_res->trace, &uuid_buf);
+  ERL_NIF_TERM uuid = (res == 0) ? buf2term(env, uuid_buf) : atom_error;
+  unlock_trace(trace_res);
 
-  ErlNifBinary uuid_bin = buf2bin(uuid_buf);
+  MAYBE_RAISE_FFI(res);
 
-  return enif_make_binary(env, &uuid_bin);
+  return uuid;
 }
 
 // Wraps:
@@ -413,15 +509,17 @@ static ERL_NIF_TERM sky_trace_set_uuid_nif(ErlNifEnv *env, int argc, const ERL_N
 
   CHECK_TYPE(argv[1], binary);
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
-
   ErlNifBinary uuid_bin;
   enif_inspect_binary(env, argv[1], &uuid_bin);
 
   sky_buf_t uuid_buf = bin2buf(uuid_bin);
 
-  int res = sky_trace_set_uuid(trace, uuid_buf);
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
+
+  int res = sky_trace_set_uuid(trace_res->trace, uuid_buf);
+  unlock_trace(trace_res);
+
   return FFI_RESULT(res);
 }
 
@@ -435,9 +533,6 @@ static ERL_NIF_TERM sky_trace_instrument_nif(ErlNifEnv *env, int argc, const ERL
   CHECK_TYPE(argv[1], number);
   CHECK_TYPE(argv[2], binary);
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
-
   uint64_t time;
   enif_get_uint64(env, argv[1], (ErlNifUInt64 *) &time);
 
@@ -446,8 +541,14 @@ static ERL_NIF_TERM sky_trace_instrument_nif(ErlNifEnv *env, int argc, const ERL
 
   sky_buf_t category_buf = bin2buf(category_bin);
 
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
+
   uint32_t out;
-  MAYBE_RAISE_FFI(sky_trace_instrument(trace, time, category_buf, &out));
+  int res = sky_trace_instrument(trace_res->trace, time, category_buf, &out);
+  unlock_trace(trace_res);
+
+  MAYBE_RAISE_FFI(res);
 
   return enif_make_uint(env, (unsigned int) out);
 }
@@ -462,9 +563,6 @@ static ERL_NIF_TERM sky_trace_span_set_title_nif(ErlNifEnv *env, int argc, const
   CHECK_TYPE(argv[1], number);
   CHECK_TYPE(argv[2], binary);
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
-
   uint32_t handle;
   enif_get_uint(env, argv[1], (unsigned int *) &handle);
 
@@ -473,7 +571,12 @@ static ERL_NIF_TERM sky_trace_span_set_title_nif(ErlNifEnv *env, int argc, const
 
   sky_buf_t title_buf = bin2buf(title_bin);
 
-  int res = sky_trace_span_set_title(trace, handle, title_buf);
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
+
+  int res = sky_trace_span_set_title(trace_res->trace, handle, title_buf);
+  unlock_trace(trace_res);
+
   return FFI_RESULT(res);
 }
 
@@ -487,9 +590,6 @@ static ERL_NIF_TERM sky_trace_span_set_desc_nif(ErlNifEnv *env, int argc, const
   CHECK_TYPE(argv[1], number);
   CHECK_TYPE(argv[2], binary);
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
-
   uint32_t handle;
   enif_get_uint(env, argv[1], (unsigned int *) &handle);
 
@@ -498,7 +598,12 @@ static ERL_NIF_TERM sky_trace_span_set_desc_nif(ErlNifEnv *env, int argc, const
 
   sky_buf_t desc_buf = bin2buf(desc_bin);
 
-  int res = sky_trace_span_set_desc(trace, handle, desc_buf);
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
+
+  int res = sky_trace_span_set_desc(trace_res->trace, handle, desc_buf);
+  unlock_trace(trace_res);
+
   return FFI_RESULT(res);
 }
 
@@ -512,16 +617,18 @@ static ERL_NIF_TERM sky_trace_span_done_nif(ErlNifEnv *env, int argc, const ERL_
   CHECK_TYPE(argv[1], number);
   CHECK_TYPE(argv[2], number);
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
-
   uint32_t handle;
   enif_get_uint(env, argv[1], (unsigned int *) &handle);
 
   uint64_t time;
   enif_get_uint64(env, argv[2], (ErlNifUInt64 *) &time);
 
-  int res = sky_trace_span_done(trace, handle, time);
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
+
+  int res = sky_trace_span_done(trace_res->trace, handle, time);
+  unlock_trace(trace_res);
+
   return FFI_RESULT(res);
 }
 
@@ -535,9 +642,6 @@ static ERL_NIF_TERM sky_trace_span_set_sql_nif(ErlNifEnv *env, int argc, const E
   CHECK_TYPE(argv[2], binary);
   CHECK_TYPE(argv[3], number);
 
-  sky_trace_t *trace;
-  CHECK_TRACE(get_trace(env, argv[0], &trace));
-
   uint32_t handle;
   enif_get_uint(env, argv[1], (unsigned int *) &handle);
 
@@ -547,10 +651,91 @@ static ERL_NIF_TERM sky_trace_span_set_sql_nif(ErlNifEnv *env, int argc, const E
   int flavor;
   enif_get_int(env, argv[3], &flavor);
 
-  int res = sky_trace_span_set_sql(trace, handle, bin2buf(sql_bin), flavor);
+  trace_res_t *trace_res;
+  CHECK_TRACE(lock_trace(env, argv[0], &trace_res));
+
+  int res = sky_trace_span_set_sql(trace_res->trace, handle, bin2buf(sql_bin), flavor);
+  unlock_trace(trace_res);
+
   return FFI_RESULT(res);
 }
 
+// Frees the traces in the trace index that were started before `older_than`,
+// at most `limit` of them per call. These are traces that are still alive but
+// were never submitted, usually because the process that owns them hung (the
+// traces of dead processes are garbage-collected right away). Traces that are
+// in use while this runs are left alone for the next sweep.
+//
+// Reaped traces are not submitted (they're unfinished, so their timings would
+// be bogus). Any later use of them is a no-op that returns `:error`.
+//
+//   trace_reap(older_than :: integer, limit :: pos_integer) :: [endpoint :: binary]
+static ERL_NIF_TERM sky_trace_reap_nif(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[]) {
+  RAISE_IF_LIBSKYLIGHT_NOT_LOADED();
+
+  ErlNifUInt64 older_than;
+  unsigned int limit;
+
+  if (!enif_get_uint64(env, argv[0], &older_than) ||
+      !enif_get_uint(env, argv[1], &limit) ||
+      limit == 0) {
+    return enif_make_badarg(env);
+  }
+
+  sky_trace_t **reaped = enif_alloc(sizeof(sky_trace_t *) * limit);
+  if (reaped == NULL) {
+    ERL_RAISE("couldn't allocate memory for reaped traces");
+  }
+  unsigned int reaped_count = 0;
+
+  // Under the index lock, we only take the expired traces away from their
+  // resources and unlink them. From then on, nobody else can reach those
+  // traces, so the expensive work happens after the lock is dropped. We steal
+  // the `sky_trace_t` instead of keeping the resource because a resource in the
+  // index can be in the middle of its destructor (waiting for the index lock).
+  enif_mutex_lock(TRACE_INDEX_LOCK);
+
+  // The index is sorted by start time, so we can stop at the first trace that
+  // is recent enough.
+  trace_res_t *node = trace_index_head;
+  while (node != NULL && node->started_at < (uint64_t) older_than && reaped_count < limit) {
+    trace_res_t *next = node->next;
+
+    // Never block on a trace lock while holding the index lock. If the trace is
+    // locked, its process is using it right now.
+    if (enif_mutex_trylock(node->lock) == 0) {
+      if (node->trace != NULL) {
+        reaped[reaped_count++] = node->trace;
+        node->trace = NULL;
+        node->reaped = 1;
+      }
+
+      enif_mutex_unlock(node->lock);
+
+      trace_index_unlink(node);
+    }
+
+    node = next;
+  }
+
+  enif_mutex_unlock(TRACE_INDEX_LOCK);
+
+  ERL_NIF_TERM endpoints = enif_make_list(env, 0);
+
+  for (unsigned int i = 0; i < reaped_count; i++) {
+    sky_buf_t endpoint_buf;
+    if (sky_trace_endpoint(reaped[i], &endpoint_buf) == 0) {
+      endpoints = enif_make_list_cell(env, buf2term(env, endpoint_buf), endpoints);
+    }
+
+    sky_trace_free(reaped[i]);
+  }
+
+  enif_free(reaped);
+
+  return endpoints;
+}
+
 // Wraps:
 //   int sky_lex_sql(sky_buf_t sql, sky_buf_t* title_buf, sky_buf_t* desc_buf);
 // in:
@@ -602,31 +787,102 @@ sky_buf_t bin2buf(ErlNifBinary bin) {
   };
 }
 
-ErlNifBinary buf2bin(sky_buf_t buf) {
-  return (ErlNifBinary) {
-    .data = buf.data,
-    .size = buf.len,
-  };
-}
-
 void get_instrumenter(ErlNifEnv *env, ERL_NIF_TERM resource_arg, sky_instrumenter_t **instrumenter) {
   sky_instrumenter_t **resource;
   enif_get_resource(env, resource_arg, INSTRUMENTER_RES_TYPE, (void *) &resource);
   *instrumenter = *resource;
 }
 
-int get_trace(ErlNifEnv *env, ERL_NIF_TERM resource_arg, sky_trace_t **trace) {
-  sky_trace_t **trace_res;
-  enif_get_resource(env, resource_arg, TRACE_RES_TYPE, (void **) &trace_res);
+// Copies `buf` into a new Erlang binary.
+ERL_NIF_TERM buf2term(ErlNifEnv *env, sky_buf_t buf) {
+  ERL_NIF_TERM term;
+  unsigned char *data = enif_make_new_binary(env, buf.len, &term);
+  memcpy(data, buf.data, buf.len);
+  return term;
+}
 
-  if (*trace_res == NULL) {
-    return -1;
+// Fetches the trace resource from `resource_arg` and locks it. Returns 0 if the
+// trace is still alive, in which case it must be unlocked with
+// `unlock_trace()`. Otherwise, returns `TRACE_NULLED` or `TRACE_REAPED` and
+// leaves the trace unlocked.
+int lock_trace(ErlNifEnv *env, ERL_NIF_TERM resource_arg, trace_res_t **trace_res) {
+  enif_get_resource(env, resource_arg, TRACE_RES_TYPE, (void **) trace_res);
+
+  enif_mutex_lock((*trace_res)->lock);
+
+  if ((*trace_res)->trace == NULL) {
+    int reaped = (*trace_res)->reaped;
+    enif_mutex_unlock((*trace_res)->lock);
+    return reaped ? TRACE_REAPED : TRACE_NULLED;
   } else {
-    *trace = *trace_res;
     return 0;
   }
 }
 
+void unlock_trace(trace_res_t *trace_res) {
+  enif_mutex_unlock(trace_res->lock);
+}
+
+// Adds `trace_res` to the trace index, keeping it sorted by start time. Traces
+// are almost always created in start order, so we look for the right spot
+// starting from the tail.
+void trace_index_insert(trace_res_t *trace_res) {
+  enif_mutex_lock(TRACE_INDEX_LOCK);
+
+  trace_res_t *prev = trace_index_tail;
+  while (prev != NULL && prev->started_at > trace_res->started_at) {
+    prev = prev->prev;
+  }
+
+  trace_res->prev = prev;
+  trace_res->next = (prev != NULL) ? prev->next : trace_index_head;
+
+  if (trace_res->next != NULL) {
+    trace_res->next->prev = trace_res;
+  } else {
+    trace_index_tail = trace_res;
+  }
+
+  if (prev != NULL) {
+    prev->next = trace_res;
+  } else {
+    trace_index_head = trace_res;
+  }
+
+  trace_res->indexed = 1;
+
+  enif_mutex_unlock(TRACE_INDEX_LOCK);
+}
+
+// Removes `trace_res` from the trace index. Does nothing if it's not in there.
+void trace_index_remove(trace_res_t *trace_res) {
+  enif_mutex_lock(TRACE_INDEX_LOCK);
+  trace_index_unlink(trace_res);
+  enif_mutex_unlock(TRACE_INDEX_LOCK);
+}
+
+// Same as `trace_index_remove()`, but the caller must hold `TRACE_INDEX_LOCK`.
+void trace_index_unlink(trace_res_t *trace_res) {
+  if (!trace_res->indexed) {
+    return;
+  }
+
+  if (trace_res->prev != NULL) {
+    trace_res->prev->next = trace_res->next;
+  } else {
+    trace_index_head = trace_res->next;
+  }
+
+  if (trace_res->next != NULL) {
+    trace_res->next->prev = trace_res->prev;
+  } else {
+    trace_index_tail = trace_res->prev;
+  }
+
+  trace_res->prev = trace_res->next = NULL;
+  trace_res->indexed = 0;
+}
+
 
 // List of functions to define in the module that loads this NIF file.
 static ErlNifFunc nif_funcs[] = {
@@ -648,6 +904,7 @@ static ErlNifFunc nif_funcs[] = {
   {"trace_span_set_desc", 3, sky_trace_span_set_desc_nif},
   {"trace_span_done", 3, sky_trace_span_done_nif},
   {"trace_span_set_sql", 4, sky_trace_span_set_sql_nif},
+  {"trace_reap", 2, sky_trace_reap_nif},
   {"lex_sql", 1, sky_lex_sql_nif}
 };
 
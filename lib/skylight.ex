@@ -12,6 +12,7 @@ defmodule Skylight do
 
     children = [
       worker(Skylight.Store, []),
+      worker(Skylight.Reaper, []),
     ]
 
     Supervisor.start_link(children, strategy: :one_for_one)
@@ -44,14 +45,16 @@ defmodule Skylight do
   def phoenix_controller_render(:start, _compile, runtime) do
     trace = Trace.fetch()
 
+    # `handle` is :error if the trace was reaped, which makes the span calls
+    # no-ops.
     handle = Trace.instrument(trace, "view.render")
-    :ok = Trace.set_span_title(trace, handle, runtime.template)
+    Trace.set_span_title(trace, handle, runtime.template)
 
     {:ok, handle}
   end
 
   def phoenix_controller_render(:stop, _diff, {:ok, handle}) do
     trace = Trace.fetch()
-    :ok = Trace.mark_span_as_done(trace, handle)
+    Trace.mark_span_as_done(trace, handle)
   end
 end
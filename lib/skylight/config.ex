@@ -7,6 +7,9 @@ defmodule Skylight.Config do
   @priv Application.app_dir(:skylight, "priv")
   @required ~w(authentication)a
 
+  # Keys that configure this library and are not passed to the Skylight agent.
+  @local ~w(reaper)a
+
   @doc """
   Reads the configuration.
 
@@ -23,6 +26,7 @@ defmodule Skylight.Config do
   @spec read() :: %{}
   def read do
     Application.get_all_env(:skylight) # [foo: :bar, baz: {:system, "QUUX"}]
+    |> Keyword.drop(@local)            # same as above, without non-agent keys
     |> read_env_variables()            # [foo: :bar, baz: :quux]
     |> ensure_required()               # same as above, raising if required are not present
     |> merge_with_defaults()           # %{foo: :bar, baz: :quuz, def: :ault}
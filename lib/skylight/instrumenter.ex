@@ -56,6 +56,8 @@ defmodule Skylight.Instrumenter do
   other Skylight functions after calling this function (this includes things
   like `inspect(trace)`, since Skylight defines the `Inspect` protocol for
   traces).
+
+  Returns `:error` if `trace` was reaped (see `Skylight.Trace.reap/2`).
   """
   @spec submit_trace(t, Trace.t) :: :ok | :error
   def submit_trace(%Instrumenter{} = inst, %Trace{} = trace) do
@@ -58,6 +58,7 @@ defmodule Skylight.NIF do
   defnif trace_span_set_desc(trace, handle, desc)
   defnif trace_span_done(trace, handle, time)
   defnif trace_span_set_sql(trace, handle, sql, flavor)
+  defnif trace_reap(older_than, limit)
   defnif lex_sql(sql)
 
   # Loads the .so file that contains the NIFs.
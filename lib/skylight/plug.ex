@@ -38,11 +38,13 @@ if Code.ensure_compiled?(Plug) do
     end
 
     def call(conn, _opts) do
-      trace = Trace.new("default")
+      # The real endpoint is only known in before_send/2. Until then, the
+      # method and path identify the request if its trace gets reaped.
+      trace = Trace.new(conn.method <> " " <> conn.request_path)
       :ok = Trace.store(trace)
 
       whole_req_handle = Trace.instrument(trace, "app.whole_req")
-      :ok = Trace.set_span_title(trace, whole_req_handle, "app.whole_req")
+      Trace.set_span_title(trace, whole_req_handle, "app.whole_req")
 
       Logger.debug "Created a new trace for request at \"#{conn.request_path}\": #{inspect trace}"
 
@@ -52,12 +54,16 @@ if Code.ensure_compiled?(Plug) do
     defp before_send(conn, whole_req_handle) do
       trace = Trace.fetch()
 
-      if endpoint = get_route(conn) do
-        :ok = Trace.set_endpoint(trace, endpoint)
-      end
+      # If the request took long enough for its trace to be reaped, all of
+      # these are no-ops that return :error, and the response goes out anyway.
+      Trace.set_endpoint(trace, get_route(conn) || "default")
+
+      Trace.mark_span_as_done(trace, whole_req_handle)
 
-      :ok = Trace.mark_span_as_done(trace, whole_req_handle)
-      :ok = Instrumenter.submit_trace(Store.get_instrumenter(), trace)
+      case Instrumenter.submit_trace(Store.get_instrumenter(), trace) do
+        :ok    -> :ok
+        :error -> Logger.debug "Couldn't submit the trace for request at \"#{conn.request_path}\""
+      end
 
       Trace.unstore()
 
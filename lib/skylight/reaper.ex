@@ -0,0 +1,122 @@
+defmodule Skylight.Reaper do
+  @moduledoc """
+  Periodically frees traces that were never submitted.
+
+  A trace is normally submitted (and freed) by `Skylight.Plug` right before the
+  response is sent, and the trace of a process that dies is garbage-collected
+  with it. A request that hangs, however, keeps its trace in memory for as long
+  as it runs. This process sweeps such traces every `:interval` milliseconds,
+  freeing the ones older than `:max_age` milliseconds (at most `:limit` per
+  sweep) and logging how many it freed along with some of their endpoints. The
+  request itself is not affected; see the "Reaped traces" section in the
+  `Skylight.Trace` documentation.
+
+  It's configured through the `:reaper` key of the `:skylight` application:
+
+      config :skylight,
+        reaper: [interval: 30_000, max_age: 300_000, limit: 1_000]
+
+  All the options are optional. Setting `reaper: true` uses the defaults shown
+  above and setting `reaper: false` disables the reaper.
+  """
+
+  use GenServer
+
+  require Logger
+
+  alias Skylight.Trace
+
+  @defaults [interval: 30_000, max_age: 300_000, limit: 1_000]
+
+  # How many endpoints of reaped traces to show in the log for each sweep.
+  @log_sample 10
+
+  ## Public API
+
+  @doc """
+  Starts the reaper with the given configuration, or returns `:ignore` if it's
+  disabled.
+
+  `config` defaults to the `:reaper` key of the `:skylight` application env.
+  Raises an `ArgumentError` if the configuration is not valid.
+  """
+  @spec start_link(boolean | Keyword.t) :: GenServer.on_start
+  def start_link(config \\ Application.get_env(:skylight, :reaper, true))
+
+  def start_link(false) do
+    :ignore
+  end
+
+  def start_link(config) do
+    GenServer.start_link(__MODULE__, validate_config!(config))
+  end
+
+  ## Callbacks
+
+  @doc false
+  def init(opts) do
+    schedule_sweep(opts[:interval])
+    {:ok, opts}
+  end
+
+  @doc false
+  def handle_info(:sweep, opts) do
+    reaped = Trace.reap(opts[:max_age], opts[:limit])
+
+    unless reaped == [] do
+      log_reaped(reaped)
+    end
+
+    # If we hit the limit there are probably more traces to reap, so we sweep
+    # again right away (after handling any other message in the mailbox).
+    if length(reaped) == opts[:limit] do
+      send(self(), :sweep)
+    else
+      schedule_sweep(opts[:interval])
+    end
+
+    {:noreply, opts}
+  end
+
+  ## Helpers
+
+  defp validate_config!(true) do
+    @defaults
+  end
+
+  defp validate_config!(config) do
+    unless Keyword.keyword?(config) do
+      raise ArgumentError,
+        "the :reaper configuration of the :skylight application must be a boolean " <>
+        "or a keyword list, got: #{inspect config}"
+    end
+
+    opts = Keyword.merge(@defaults, config)
+
+    for key <- Keyword.keys(@defaults) do
+      value = opts[key]
+
+      unless is_integer(value) and value > 0 do
+        raise ArgumentError,
+          "the #{inspect key} option of the :reaper configuration of the :skylight " <>
+          "application must be a positive integer, got: #{inspect value}"
+      end
+    end
+
+    opts
+  end
+
+  defp log_reaped(endpoints) do
+    count = length(endpoints)
+    {sample, rest} = Enum.split(endpoints, @log_sample)
+
+    sample = Enum.map_join(sample, ", ", &inspect/1)
+    more = if rest == [], do: "", else: " and #{length(rest)} more"
+
+    Logger.warn "Reaped #{count} trace(s) that were never submitted: #{sample}#{more}"
+  end
+
+  defp schedule_sweep(interval) do
+    Process.send_after(self(), :sweep, interval)
+  end
+end
@@ -4,6 +4,14 @@ defmodule Skylight.Trace do
 
   The internal structure of the `Skylight.Trace` struct is purposefully not
   documented as it's not public.
+
+  ## Reaped traces
+
+  Traces that stay alive for too long are freed by `Skylight.Reaper` (see
+  `reap/2`). The request that owns a reaped trace may still be running, so all
+  the functions in this module are no-ops that return `:error` when called on a
+  reaped trace. In particular, `instrument/2` returns `:error` instead of a
+  handle, and passing that `:error` as a handle is a no-op as well.
   """
 
   @type t :: %__MODULE__{
@@ -11,6 +19,7 @@ defmodule Skylight.Trace do
   }
 
   @type handle :: non_neg_integer
+  @type maybe_handle :: handle | :error
   @type sql_flavor :: :generic | :mysql | :postgres
 
   alias __MODULE__
@@ -45,7 +54,7 @@ defmodule Skylight.Trace do
 
   The returned time is in 1/10ms.
   """
-  @spec get_started_at(t) :: non_neg_integer
+  @spec get_started_at(t) :: non_neg_integer | :error
   def get_started_at(%Trace{} = trace) do
     NIF.trace_start(trace.resource)
   end
@@ -53,7 +62,7 @@ defmodule Skylight.Trace do
   @doc """
   Returns the endpoint of the given trace.
   """
-  @spec get_endpoint(t) :: binary
+  @spec get_endpoint(t) :: binary | :error
   def get_endpoint(%Trace{} = trace) do
     NIF.trace_endpoint(trace.resource)
   end
@@ -72,7 +81,7 @@ defmodule Skylight.Trace do
   @doc """
   Gets the UUID of the given trace.
   """
-  @spec get_uuid(t) :: binary
+  @spec get_uuid(t) :: binary | :error
   def get_uuid(%Trace{} = trace) do
     NIF.trace_uuid(trace.resource)
   end
@@ -94,7 +103,7 @@ defmodule Skylight.Trace do
   The returned handle will identify the created span for the duration of its
   lifetime. `category` is the category that will set for the new span.
   """
-  @spec instrument(t, binary) :: handle
+  @spec instrument(t, binary) :: maybe_handle
   def instrument(%Trace{} = trace, category) when is_binary(category) do
     NIF.trace_instrument(trace.resource, normalized_hrtime(), category)
   end
@@ -106,7 +115,13 @@ defmodule Skylight.Trace do
   `instrument/2`). The trace (and the target span) are modified in place (no
   Erlang immutability heaven here), so use this carefully.
   """
-  @spec set_span_title(t, handle, binary) :: :ok | :error
+  @spec set_span_title(t, maybe_handle, binary) :: :ok | :error
+  def set_span_title(trace, handle, title)
+
+  def set_span_title(%Trace{}, :error, title) when is_binary(title) do
+    :error
+  end
+
   def set_span_title(%Trace{} = trace, handle, title) when is_integer(handle) and is_binary(title) do
     NIF.trace_span_set_title(trace.resource, handle, title)
   end
@@ -118,7 +133,13 @@ defmodule Skylight.Trace do
   `instrument/2`). The trace (and the target span) are modified in place (no
   Erlang immutability heaven here), so use this carefully.
   """
-  @spec set_span_desc(t, handle, binary) :: :ok | :error
+  @spec set_span_desc(t, maybe_handle, binary) :: :ok | :error
+  def set_span_desc(trace, handle, desc)
+
+  def set_span_desc(%Trace{}, :error, desc) when is_binary(desc) do
+    :error
+  end
+
   def set_span_desc(%Trace{} = trace, handle, desc) when is_integer(handle) and is_binary(desc) do
     NIF.trace_span_set_desc(trace.resource, handle, desc)
   end
@@ -135,7 +156,14 @@ defmodule Skylight.Trace do
   `instrument/2`). The trace (and the target span) are modified in place (no
   Erlang immutability heaven here), so use this carefully.
   """
-  @spec set_span_sql(t, handle, binary, sql_flavor) :: :ok | :error
+  @spec set_span_sql(t, maybe_handle, binary, sql_flavor) :: :ok | :error
+  def set_span_sql(trace, handle, sql, flavor)
+
+  def set_span_sql(%Trace{}, :error, sql, flavor)
+      when is_binary(sql) and flavor in unquote(Map.keys(@sql_flavors)) do
+    :error
+  end
+
   def set_span_sql(%Trace{} = trace, handle, sql, flavor)
       when is_integer(handle) and is_binary(sql) and flavor in unquote(Map.keys(@sql_flavors)) do
     NIF.trace_span_set_sql(trace.resource, handle, sql, @sql_flavors[flavor])
@@ -148,11 +176,33 @@ defmodule Skylight.Trace do
   `instrument/2`). The `trace` (and the target span) are modified in place (no
   Erlang immutability heaven here), so use this carefully.
   """
-  @spec mark_span_as_done(t, handle) :: :ok | :error
+  @spec mark_span_as_done(t, maybe_handle) :: :ok | :error
+  def mark_span_as_done(trace, handle)
+
+  def mark_span_as_done(%Trace{}, :error) do
+    :error
+  end
+
   def mark_span_as_done(%Trace{} = trace, handle) when is_integer(handle) do
     NIF.trace_span_done(trace.resource, handle, normalized_hrtime())
   end
 
+  @doc """
+  Frees the traces that were started more than `max_age` milliseconds ago and
+  were never submitted, at most `limit` of them.
+
+  These are traces whose request is taking too long (the traces of processes
+  that die are garbage-collected right away). Reaped traces are not submitted;
+  see the "Reaped traces" section in the module documentation. Returns the
+  endpoints of the reaped traces.
+  """
+  @spec reap(non_neg_integer, pos_integer) :: [binary]
+  def reap(max_age, limit)
+      when is_integer(max_age) and max_age >= 0 and is_integer(limit) and limit > 0 do
+    # Trace start times are in 1/10ms.
+    NIF.trace_reap(max(normalized_hrtime() - max_age * 10, 0), limit)
+  end
+
   @doc """
   Stores the given trace in the process dictionary.
   """
@@ -192,8 +242,15 @@ defmodule Skylight.Trace do
     import Inspect.Algebra
 
     def inspect(%Trace{} = trace, opts) do
+      case Skylight.Trace.get_uuid(trace) do
+        :error -> "#Skylight.Trace<reaped>"
+        uuid   -> inspect_trace(trace, uuid, opts)
+      end
+    end
+
+    defp inspect_trace(trace, uuid, opts) do
       concat ["#Skylight.Trace<",
-              "uuid: ", Skylight.Trace.get_uuid(trace),
+              "uuid: ", uuid,
               ", ",
               "endpoint: ", to_doc(Skylight.Trace.get_endpoint(trace), opts),
               ">"]
@@ -7,6 +7,7 @@ defmodule Skylight.ConfigTest do
     Application.put_env(:skylight, :foo, {:system, "SKYLIGHT_TESTS_FOO"})
     Application.put_env(:skylight, :nil_env, {:system, "SKYLIGHT_TEST_NONEXISTENT"})
     Application.put_env(:skylight, :bar_with_underscore, true)
+    Application.put_env(:skylight, :reaper, [max_age: 1_000])
 
     System.put_env("SKYLIGHT_TESTS_FOO", "yay!")
 
@@ -15,5 +16,6 @@ defmodule Skylight.ConfigTest do
     assert config["SKYLIGHT_FOO"] == "yay!"
     assert config["SKYLIGHT_BAR_WITH_UNDERSCORE"] == "true"
     refute Map.has_key?(config, "SKYLIGHT_NIL_ENV")
+    refute Map.has_key?(config, "SKYLIGHT_REAPER")
   end
 end
@@ -88,6 +88,41 @@ defmodule Skylight.NIFTest do
     assert :ok = trace_span_done(trace, handle, hrtime())
   end
 
+  test "trace_reap/2" do
+    endpoint = "MyController#my_reaped_endpoint"
+    old_trace = trace_new(100, UUID.uuid4(), endpoint)
+    new_trace = trace_new(hrtime(), UUID.uuid4(), "MyController#my_endpoint")
+
+    assert endpoint in trace_reap(200, 1_000)
+    refute endpoint in trace_reap(200, 1_000)
+
+    assert trace_endpoint(old_trace) == :error
+    assert trace_endpoint(new_trace) == "MyController#my_endpoint"
+  end
+
+  test "trace_reap/2 with a limit" do
+    traces = for _ <- 1..3, do: trace_new(100, UUID.uuid4(), "MyController#my_limited_endpoint")
+
+    assert length(trace_reap(200, 2)) == 2
+    assert length(trace_reap(200, 2)) == 1
+    assert Enum.all?(traces, &(trace_endpoint(&1) == :error))
+    assert_raise ArgumentError, fn -> trace_reap(200, 0) end
+  end
+
+  test "trace functions on a reaped trace", %{inst: instrumenter} do
+    trace = trace_new(100, UUID.uuid4(), "MyController#my_endpoint")
+    handle = trace_instrument(trace, 100, "my_category")
+    trace_reap(200, 1_000)
+
+    assert trace_start(trace) == :error
+    assert trace_uuid(trace) == :error
+    assert trace_set_endpoint(trace, "MyController#new_endpoint") == :error
+    assert trace_instrument(trace, hrtime(), "my_category") == :error
+    assert trace_span_set_title(trace, handle, "my title") == :error
+    assert trace_span_done(trace, handle, hrtime()) == :error
+    assert instrumenter_submit_trace(instrumenter, trace) == :error
+  end
+
   test "lex_sql/1" do
     sql = "SELECT * FROM my_table WHERE my_field = 'my value'";
     assert lex_sql(sql) == "SELECT * FROM my_table WHERE my_field = ?";
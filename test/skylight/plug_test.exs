@@ -0,0 +1,69 @@
+defmodule Skylight.PlugTest do
+  use ExUnit.Case
+  use Plug.Test
+
+  import ExUnit.CaptureLog
+
+  alias Skylight.Reaper
+  alias Skylight.Trace
+
+  @opts Skylight.Plug.init([])
+
+  test "instruments and submits the request" do
+    conn = conn(:get, "/") |> Skylight.Plug.call(@opts)
+    assert %Trace{} = Trace.fetch()
+
+    conn = send_resp(conn, 200, "ok")
+
+    assert conn.state == :sent
+    assert conn.status == 200
+    assert Trace.fetch() == nil
+  end
+
+  test "the trace is named after the request until the response is sent" do
+    conn = conn(:get, "/my/path") |> Skylight.Plug.call(@opts)
+    assert Trace.get_endpoint(Trace.fetch()) == "GET /my/path"
+    send_resp(conn, 200, "ok")
+  end
+
+  test "the reaper log names the path of a hung request" do
+    _conn = conn(:post, "/my/hung/request") |> Skylight.Plug.call(@opts)
+    trace = Trace.fetch()
+
+    log = capture_log fn ->
+      {:ok, _pid} = Reaper.start_link(interval: 10, max_age: 10)
+      wait_until fn -> Trace.get_endpoint(trace) == :error end
+      :timer.sleep(10)
+    end
+
+    assert log =~ ~s("POST /my/hung/request")
+  end
+
+  test "a request whose trace is reaped still gets a response" do
+    conn = conn(:get, "/") |> Skylight.Plug.call(@opts)
+    trace = Trace.fetch()
+
+    :timer.sleep(20)
+    Trace.reap(10, 1_000)
+    assert Trace.get_endpoint(trace) == :error
+
+    conn = send_resp(conn, 200, "ok")
+
+    assert conn.state == :sent
+    assert conn.status == 200
+    assert conn.resp_body == "ok"
+    assert Trace.fetch() == nil
+  end
+
+  defp wait_until(fun, attempts \\ 100) do
+    cond do
+      fun.() ->
+        :ok
+      attempts == 0 ->
+        flunk "condition was never met"
+      true ->
+        :timer.sleep(10)
+        wait_until(fun, attempts - 1)
+    end
+  end
+end
@@ -0,0 +1,70 @@
+defmodule Skylight.ReaperTest do
+  use ExUnit.Case
+
+  import ExUnit.CaptureLog
+
+  alias Skylight.Reaper
+  alias Skylight.Trace
+
+  test "start_link/1 with false" do
+    assert Reaper.start_link(false) == :ignore
+  end
+
+  test "start_link/1 with true" do
+    assert {:ok, pid} = Reaper.start_link(true)
+    assert Process.alive?(pid)
+  end
+
+  test "start_link/1 with an invalid configuration" do
+    assert_raise ArgumentError, ~r/must be a boolean or a keyword list/, fn ->
+      Reaper.start_link(:yes)
+    end
+
+    assert_raise ArgumentError, ~r/:interval option .* must be a positive integer/, fn ->
+      Reaper.start_link(interval: 0)
+    end
+
+    assert_raise ArgumentError, ~r/:max_age option .* must be a positive integer/, fn ->
+      Reaper.start_link(max_age: -1)
+    end
+  end
+
+  test "traces older than max_age are reaped" do
+    trace = Trace.new("my_trace_for_the_reaper")
+
+    log = capture_log fn ->
+      {:ok, _pid} = Reaper.start_link(interval: 10, max_age: 10)
+      wait_until fn -> Trace.get_endpoint(trace) == :error end
+      :timer.sleep(10)
+    end
+
+    assert log =~ ~s(Reaped 1 trace(s) that were never submitted: "my_trace_for_the_reaper")
+  end
+
+  test "each sweep logs a single summary line" do
+    traces = for i <- 1..15, do: Trace.new("my_hung_trace_#{i}")
+    :timer.sleep(20)
+
+    log = capture_log fn ->
+      {:ok, pid} = Reaper.start_link(interval: 60_000, max_age: 10)
+      send(pid, :sweep)
+      wait_until fn -> Enum.all?(traces, &(Trace.get_endpoint(&1) == :error)) end
+      :timer.sleep(10)
+    end
+
+    assert length(Regex.scan(~r/Reaped \d+ trace/, log)) == 1
+    assert log =~ ~r/Reaped 15 trace\(s\) that were never submitted: .* and 5 more/
+  end
+
+  defp wait_until(fun, attempts \\ 100) do
+    cond do
+      fun.() ->
+        :ok
+      attempts == 0 ->
+        flunk "condition was never met"
+      true ->
+        :timer.sleep(10)
+        wait_until(fun, attempts - 1)
+    end
+  end
+end
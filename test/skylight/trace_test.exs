@@ -1,7 +1,11 @@
 defmodule Skylight.TraceTest do
-  use ExUnit.Case, async: true
+  # Not async: reap/2 frees the expired traces of every process, not just the
+  # ones created by the test that calls it.
+  use ExUnit.Case
 
   alias Skylight.Trace
+  alias Skylight.Instrumenter
+  alias Skylight.Store
 
   test "implementation of Inspect.inspect/2" do
     assert inspect(Trace.new("my_trace"))
@@ -42,4 +46,59 @@ defmodule Skylight.TraceTest do
     assert :ok = Trace.set_span_desc(trace, handle, "my desc")
     assert :ok = Trace.mark_span_as_done(trace, handle)
   end
+
+  test "reap/2" do
+    trace = Trace.new("my_trace_to_reap")
+    :timer.sleep(100)
+
+    # max_age is in milliseconds while trace start times are in 1/10ms.
+    refute "my_trace_to_reap" in Trace.reap(1_000, 1_000)
+    assert "my_trace_to_reap" in Trace.reap(10, 1_000)
+    refute "my_trace_to_reap" in Trace.reap(10, 1_000)
+
+    assert Trace.get_endpoint(trace) == :error
+  end
+
+  test "reap/2 with a max_age larger than the current time" do
+    trace = Trace.new("my_trace_too_recent_to_reap")
+    assert Trace.reap(1_000_000_000_000, 1_000) == []
+    assert Trace.get_endpoint(trace) == "my_trace_too_recent_to_reap"
+  end
+
+  test "reap/2 with a limit" do
+    traces = for _ <- 1..3, do: Trace.new("my_trace_to_reap_with_a_limit")
+    :timer.sleep(20)
+
+    assert length(Trace.reap(10, 2)) == 2
+    assert "my_trace_to_reap_with_a_limit" in Trace.reap(10, 2)
+    assert Enum.all?(traces, &(Trace.get_endpoint(&1) == :error))
+  end
+
+  test "reap/2 doesn't return submitted traces" do
+    trace = Trace.new("my_submitted_trace")
+    assert :ok = Instrumenter.submit_trace(Store.get_instrumenter(), trace)
+    :timer.sleep(20)
+
+    refute "my_submitted_trace" in Trace.reap(10, 1_000)
+  end
+
+  test "functions on a reaped trace" do
+    trace = Trace.new("my_reaped_trace")
+    handle = Trace.instrument(trace, "my category")
+    :timer.sleep(20)
+    assert "my_reaped_trace" in Trace.reap(10, 1_000)
+
+    assert inspect(trace) == "#Skylight.Trace<reaped>"
+    assert Trace.get_started_at(trace) == :error
+    assert Trace.get_uuid(trace) == :error
+    assert Trace.set_endpoint(trace, "my_new_trace") == :error
+
+    assert Trace.instrument(trace, "my category") == :error
+    assert Trace.set_span_title(trace, handle, "my title") == :error
+    assert Trace.set_span_desc(trace, :error, "my desc") == :error
+    assert Trace.set_span_sql(trace, :error, "SELECT 1", :postgres) == :error
+    assert Trace.mark_span_as_done(trace, :error) == :error
+
+    assert Instrumenter.submit_trace(Store.get_instrumenter(), trace) == :error
+  end
 end
@@ -26,6 +26,9 @@ Mix.shell(Mix.Shell.Process)
 # manually starting the application. Note that for this to work, we had to set
 # up the "test" alias in mix.exs to run "test --no-start".
 Application.put_env(:skylight, :authentication, Skylight.TestHelpers.auth_token())
+# The reaper would reap the traces that tests create with an old start time
+# while they're still using them. Tests start their own reaper when needed.
+Application.put_env(:skylight, :reaper, false)
 Application.ensure_all_started(:skylight)
 
 ExUnit.start()